@@ -2,19 +2,24 @@
 #define ACCOUNT_H
 
 #include <compare>  // For std::strong_ordering
+#include <cstdint>  // For uint16_t, uint64_t
 #include <optional> // For std::optional
 #include <string>   // For std::string
 
-class Bank; // Forward declaration of Bank
+#include "Utils.h" // For Money
+
+class BankBase; // Forward declaration of BankBase
+template <class LoanPolicy> class BasicBank; // Forward declaration of BasicBank
 class Person; // Forward declaration of Person
 
 // Represents a bank account with owner, bank, balance, status, and credentials
 class Account {
-    friend class Bank; // Make Bank a friend of Account for full access
+    friend class BankBase; // Make Bank a friend of Account for full access
+    template <class LoanPolicy> friend class BasicBank; // Including the loan operations of every policy
 
 public:
     // Constructor with owner, bank, and password
-    Account(const Person* const owner, const Bank* const bank, std::string& password);
+    Account(const Person* const owner, const BankBase* const bank, std::string& password);
 
     // Getters
     const Person* get_owner() const;
@@ -37,15 +42,15 @@ public:
     void get_info(std::optional<std::string> file_name = std::nullopt) const;
 
 private:
-    // Member variables
+    // Member variables, hot fields first so they share a cache line
     Person* owner;
-    const Bank* bank;
-    const std::string account_number;
-    double balance;
+    const BankBase* bank;
+    const uint64_t account_number; // 16 digits, get_account_number zero-pads it back to a string
+    Money balance; // Fixed-point, get_balance converts to double
     bool account_status;
 
     // Credential variables
-    const std::string CVV2;
+    const uint16_t CVV2; // 4 digits, get_CVV2 zero-pads it back to a string
     std::string password;
     std::string exp_date;
 };
@@ -1,22 +1,56 @@
 #ifndef BANK_H // Prevents double inclusion of this header
 #define BANK_H
 
-#include <compare>  // For std::strong_ordering
-#include <map>      // For std::map
-#include <optional> // For std::optional
-#include <string>   // For std::string
-#include <vector>   // For std::vector
+#include <compare>       // For std::strong_ordering
+#include <cstdint>       // For uint64_t
+#include <map>           // For std::map
+#include <optional>      // For std::optional
+#include <string>        // For std::string
+#include <string_view>   // For std::string_view
+#include <unordered_map> // For std::unordered_map
+#include <vector>        // For std::vector
+
+#include "Utils.h" // For Money
 
 class Account; // Forward declaration of Account
 class Person; // Forward declaration of Person
+class BankBase; // Forward declaration of BankBase
+
+// Customer found by Bank::find_customer_by_fingerprint together with their accounts
+struct CustomerRecord {
+    Person* customer;
+    const std::vector<Account*>* accounts;
+};
+
+// Output formats for Bank::export_info
+enum class ExportFormat {
+    CSV,
+    JSONLines
+};
+
+// Token proving a single authentication against one bank, checked without rehashing a fingerprint
+class AuthSession {
+    friend class BankBase; // Only Bank issues and validates sessions
 
-// Represents a banking institution
-class Bank {
 public:
-    // Constructor with bank name and security fingerprint
-    Bank(const std::string& bank_name, const std::string& bank_fingerprint);
+    // Getters
+    const BankBase* get_bank() const;
+    const Person* get_owner() const; // nullptr for a bank session
 
-    ~Bank(); // Destructor
+private:
+    AuthSession(const BankBase* bank, const Person* owner, uint64_t id);
+
+    const BankBase* bank;
+    const Person* owner;
+    uint64_t id;
+};
+
+// Represents a banking institution, everything that does not depend on the loan rules
+class BankBase {
+public:
+    // Not copyable, the bank owns its accounts and its indexes point into its own containers
+    BankBase(const BankBase&) = delete;
+    BankBase& operator=(const BankBase&) = delete;
 
     // Bank operations
     Account* create_account(Person& owner, const std::string& owner_fingerprint, std::string password);
@@ -26,13 +60,22 @@ public:
     bool withdraw(Account& account, const std::string& owner_fingerprint, double amount);
     bool transfer(Account& source, Account& destination, const std::string& owner_fingerprint,
                   const std::string& CVV2, const std::string& password, const std::string& exp_date, double amount);
-    bool take_loan(Account& account, const std::string& owner_fingerprint, double amount);
-    bool pay_loan(Account& account, double amount);
 
     // Getters
     const std::string& get_bank_name() const;
     size_t get_hashed_bank_fingerprint() const;
 
+    // Looks up an account by its 16-digit number, nullptr if not found
+    Account* find_account(std::string_view account_number) const;
+
+    // Looks up a customer by their raw fingerprint, std::nullopt if they have no accounts here
+    std::optional<CustomerRecord> find_customer_by_fingerprint(const std::string& fingerprint) const;
+
+    // Session management, authenticate throws on a wrong fingerprint or if owner is not a customer here
+    AuthSession authenticate(const Person& owner, const std::string& owner_fingerprint);
+    AuthSession authenticate_bank(const std::string& bank_fingerprint);
+    bool revoke(const AuthSession& session);
+
     // Getters requiring bank authentication
     const std::vector<Person*>& get_bank_customers(std::string& bank_fingerprint) const;
     const std::vector<Account*>& get_bank_accounts(std::string& bank_fingerprint) const;
@@ -43,6 +86,16 @@ public:
     double get_bank_total_balance(std::string& bank_fingerprint) const;
     double get_bank_total_loan(std::string& bank_fingerprint) const;
 
+    // Getters requiring a bank session
+    const std::vector<Person*>& get_bank_customers(const AuthSession& bank_session) const;
+    const std::vector<Account*>& get_bank_accounts(const AuthSession& bank_session) const;
+    const std::map<Account*, Person*>& get_account_2_customer_map(const AuthSession& bank_session) const;
+    const std::map<Person*, std::vector<Account*>>& get_customer_2_accounts_map(const AuthSession& bank_session) const;
+    const std::map<Person*, double>& get_customer_2_paid_loan_map(const AuthSession& bank_session) const;
+    const std::map<Person*, double>& get_customer_2_unpaid_loan_map(const AuthSession& bank_session) const;
+    double get_bank_total_balance(const AuthSession& bank_session) const;
+    double get_bank_total_loan(const AuthSession& bank_session) const;
+
     // Account Setters requiring owner and bank authentication
     bool set_owner(Account& account, const Person* new_owner, std::string& owner_fingerprint, std::string& bank_fingerprint);
 
@@ -53,18 +106,74 @@ public:
     // Outputs bank information, supports writing to file
     void get_info(std::optional<std::string> file_name = std::nullopt) const;
 
-private:
+    // Streams every account and customer into a single file, credentials are excluded
+    void export_info(const std::string& file_name, ExportFormat format) const;
+
+protected:
+    // Constructor with bank name and security fingerprint, only built as part of a BasicBank
+    BankBase(const std::string& bank_name, const std::string& bank_fingerprint);
+
+    ~BankBase(); // Destructor
+
+    // Keeps account_number_index in sync, called by create_account, delete_account and delete_customer
+    // index_account throws if another account already holds the number
+    void index_account(Account* account);
+    void unindex_account(const Account* account);
+
+    // Keeps fingerprint_index in sync, called by create_account, delete_customer and set_owner
+    // A fingerprint identifies one customer per bank, index_customer throws if another customer holds it
+    // index_customer must run after the customer's customer_2_accounts entry is inserted
+    void index_customer(Person* customer);
+    void unindex_customer(const Person* customer);
+
+    // Keeps customer_2_total_balance in sync, called wherever an account balance or owner changes
+    // Entries that reach zero are dropped, delete_customer calls erase_customer_balance
+    void adjust_customer_balance(const Person* owner, Money delta);
+    void erase_customer_balance(const Person* owner);
+    Money recompute_customer_balance(const Person* owner) const;
+
+    // Throws unless the session is live, issued by this bank and scoped to owner (nullptr for the bank)
+    void check_session(const AuthSession& session, const Person* owner) const;
+
+    // Revokes every session issued to owner, called by delete_customer
+    void revoke_sessions(const Person* owner);
+
     // Private member variables
     const std::string bank_name;
     const size_t hashed_bank_fingerprint;
     std::vector<Person*> bank_customers;
     std::vector<Account*> bank_accounts;
     std::map<Account*, Person*> account_2_customer;
+    std::unordered_map<uint64_t, Account*> account_number_index; // Packed account number to account
     std::map<Person*, std::vector<Account*>> customer_2_accounts;
+    std::unordered_map<const Person*, Money> customer_2_total_balance; // Running sum over the customer's accounts
+    std::unordered_map<size_t, CustomerRecord> fingerprint_index; // Hashed fingerprint to customer and their customer_2_accounts entry
     std::map<Person*, double> customer_2_paid_loan;
     std::map<Person*, double> customer_2_unpaid_loan;
-    double bank_total_balance; // Total bank profit
-    double bank_total_loan; // Total loans issued
+    Money bank_total_balance; // Total bank profit, fixed-point so sums are exact
+    Money bank_total_loan; // Total loans issued, fixed-point so sums are exact
+    std::unordered_map<uint64_t, const Person*> active_sessions; // Ids of sessions not yet revoked, to their owner
 };
 
+// Represents a banking institution, LoanPolicy supplies the loan rules at compile time
+// Each policy in use needs an explicit instantiation at the end of Bank.cpp
+template <class LoanPolicy>
+class BasicBank : public BankBase {
+public:
+    // Constructor with bank name and security fingerprint
+    BasicBank(const std::string& bank_name, const std::string& bank_fingerprint)
+        : BankBase(bank_name, bank_fingerprint) {}
+
+    // Loan operations
+    bool take_loan(Account& account, const std::string& owner_fingerprint, double amount);
+    bool pay_loan(Account& account, double amount);
+
+    // Remaining loan the owner may take, LoanPolicy's limit on their total balance minus unpaid loans
+    // Building with BANK_VERIFY_CACHES cross-checks the cached balance against a full recompute
+    double loan_headroom(const Person& owner) const;
+};
+
+// The bank with the default loan rules
+using Bank = BasicBank<DefaultLoanPolicy>;
+
 #endif // BANK_H
@@ -2,9 +2,16 @@
 #define PERSON_H
 
 #include <compare>  // For std::strong_ordering
+#include <cstdint>  // For uint8_t
 #include <optional> // For std::optional
 #include <string>   // For std::string
 
+// The two accepted genders, stored in a byte instead of a string
+enum class Gender : uint8_t {
+    Female,
+    Male
+};
+
 // Models an individual with personal attributes
 class Person {
 public:
@@ -32,11 +39,12 @@ public:
     void get_info(std::optional<std::string> file_name = std::nullopt) const;
 
 private:
+    // Ordered so the small fields share one word
     const std::string name;
     size_t age;
-    const std::string gender;
     const size_t hashed_fingerprint;
-    size_t socioeconomic_rank;
+    uint8_t socioeconomic_rank; // 1 to 10, get_socioeconomic_rank widens to size_t
+    const Gender gender; // get_gender converts to "Female" or "Male"
     bool is_alive;
 };
 
@@ -0,0 +1,159 @@
+#ifndef UTILS_H // Prevents double inclusion of this header
+#define UTILS_H
+
+#include <array>       // For std::array
+#include <charconv>    // For std::to_chars
+#include <compare>     // For std::strong_ordering
+#include <cstddef>     // For size_t
+#include <cstdint>     // For int64_t, uint64_t
+#include <fstream>     // For std::ofstream
+#include <optional>    // For std::optional
+#include <string>      // For std::string
+#include <string_view> // For std::string_view
+#include <vector>      // For std::vector
+
+// Packs a 16-digit account number into an integer key, fails on any other format
+std::optional<uint64_t> pack_account_number(std::string_view account_number);
+
+// Fast thread-local pseudo-random number, seeded once per thread from std::random_device
+uint64_t random_u64();
+
+// Formats value as exactly width digits, zero-padded on the left, throws if value needs more digits
+std::string format_digits(uint64_t value, size_t width);
+
+// Unique 16-digit account numbers, a keyed permutation of a process-wide counter so they never collide
+// The keys are seeded randomly per process, so uniqueness only spans restarts if the state below is persisted
+uint64_t generate_account_number();
+std::vector<uint64_t> generate_account_numbers(size_t count);
+
+// Generator state to save alongside a bank and restore at startup, before any number is generated
+struct AccountNumberState {
+    std::array<uint64_t, 4> keys;
+    uint64_t next_index;
+};
+AccountNumberState get_account_number_state();
+void set_account_number_state(const AccountNumberState& state);
+
+// Random 4-digit CVV2
+uint16_t generate_cvv2();
+
+// Fixed-point amount of money stored as int64 minor units (cents), throws on overflow
+class Money {
+public:
+    static constexpr int64_t minor_per_unit{100};
+
+    constexpr Money() = default;
+
+    // Factories, from_double rounds to the nearest minor unit
+    static Money from_minor(int64_t minor_units);
+    static Money from_double(double amount);
+
+    // Getters
+    int64_t get_minor_units() const;
+    double to_double() const;
+
+    // Overflow-checked arithmetic
+    Money& operator+=(const Money& other);
+    Money& operator-=(const Money& other);
+    Money operator+(const Money& other) const;
+    Money operator-(const Money& other) const;
+
+    // Multiplies by numerator/denominator, rounding half away from zero
+    // e.g. (10 * rank)% is scaled(10 * rank, 100) and 10/rank percent is scaled(10, 100 * rank)
+    Money scaled(int64_t numerator, int64_t denominator) const;
+
+    // Spaceship operator for Money comparison
+    std::strong_ordering operator<=>(const Money& other) const = default;
+    bool operator==(const Money& other) const = default;
+
+private:
+    int64_t minor_units{0};
+};
+
+// Accumulates formatted records and writes them to a file in large chunks, throws on write failure
+class ExportBuffer {
+public:
+    static constexpr size_t flush_threshold{1 << 20};
+
+    explicit ExportBuffer(const std::string& file_name);
+
+    // Appenders, text is written verbatim
+    void append(std::string_view text);
+    void append(char c);
+    template <typename Number>
+    void append_number(Number value);
+    void append_digits(uint64_t value, size_t width); // Exactly width digits, zero-padded, no temporary string
+    void append_money(Money amount); // Exact decimal with two fraction digits, e.g. -12.05
+    void append_csv_field(std::string_view text); // Quoted only when it contains a comma, quote or newline
+    void append_json_string(std::string_view text); // Quoted and escaped JSON string
+
+    // Ends the current record, flushing once the buffer passes flush_threshold
+    void end_record();
+    void flush();
+
+    // Writes the remaining records, must be called once the export is complete
+    void finish();
+
+private:
+    std::ofstream file;
+    std::string buffer;
+};
+
+template <typename Number>
+void ExportBuffer::append_number(Number value) {
+    char digits[32];
+    auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, end);
+}
+
+// Builds a table indexed by socioeconomic rank at compile time, entry 0 is unused
+template <size_t MaxRank, typename Rule>
+constexpr std::array<int64_t, MaxRank + 1> make_rank_table(Rule rule) {
+    std::array<int64_t, MaxRank + 1> table{};
+    for (size_t rank{1}; rank <= MaxRank; ++rank)
+        table[rank] = rule(static_cast<int64_t>(rank));
+    return table;
+}
+
+// Loan rules of the bank, every rank-dependent value is a compile-time table
+struct DefaultLoanPolicy {
+    static constexpr size_t max_rank{10};
+
+    // A customer may borrow up to (10 * rank)% of their total balance
+    static constexpr auto limit_percent{make_rank_table<max_rank>([](int64_t rank) { return 10 * rank; })};
+
+    // Interest is 10/rank percent, kept as the fraction interest_numerator / interest_denominator[rank]
+    static constexpr int64_t interest_numerator{10};
+    static constexpr auto interest_denominator{make_rank_table<max_rank>([](int64_t rank) { return 100 * rank; })};
+
+    // Total paid loan at which a customer is upgraded from rank to rank + 1, 10^rank
+    static constexpr auto upgrade_threshold{make_rank_table<max_rank>([](int64_t rank) {
+        int64_t threshold{1};
+        for (int64_t i{0}; i < rank; ++i)
+            threshold *= 10;
+        return threshold;
+    })};
+
+    // Checked once at the entry point, the helpers below index the tables directly
+    static constexpr bool valid_rank(size_t rank) {
+        return rank >= 1 && rank <= max_rank;
+    }
+
+    // Helpers require valid_rank(rank)
+    static Money loan_limit(Money total_balance, size_t rank) {
+        return total_balance.scaled(limit_percent[rank], 100);
+    }
+
+    static Money interest(Money loan, size_t rank) {
+        return loan.scaled(interest_numerator, interest_denominator[rank]);
+    }
+
+    static bool upgrade_due(Money paid_loan, size_t rank) {
+        return rank < max_rank && paid_loan >= Money::from_minor(upgrade_threshold[rank] * Money::minor_per_unit);
+    }
+};
+
+static_assert(DefaultLoanPolicy::limit_percent[8] == 80);
+static_assert(DefaultLoanPolicy::upgrade_threshold[4] == 10'000);
+
+#endif // UTILS_H
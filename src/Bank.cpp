@@ -1,4 +1,273 @@
 #include "Bank.h"
 #include "Person.h"
 #include "Account.h"
-#include "Utils.h"
\ No newline at end of file
+#include "Utils.h"
+
+#include <atomic>     // For std::atomic
+#include <functional> // For std::hash
+#include <stdexcept>  // For std::invalid_argument, std::logic_error
+
+namespace {
+
+// Session ids come from one process-wide counter, so an id is never reused by another bank,
+// even one later allocated at the same address
+uint64_t next_session_id() {
+    static std::atomic<uint64_t> counter{1};
+    return counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+Account* BankBase::find_account(std::string_view account_number) const {
+    auto key{pack_account_number(account_number)};
+    if (!key)
+        return nullptr;
+
+    auto it{account_number_index.find(*key)};
+    return it == account_number_index.end() ? nullptr : it->second;
+}
+
+void BankBase::index_account(Account* account) {
+    auto [it, inserted] = account_number_index.try_emplace(account->account_number, account);
+    if (!inserted && it->second != account)
+        throw std::invalid_argument("Account number already belongs to another account of this bank");
+}
+
+void BankBase::unindex_account(const Account* account) {
+    account_number_index.erase(account->account_number);
+}
+
+std::optional<CustomerRecord> BankBase::find_customer_by_fingerprint(const std::string& fingerprint) const {
+    auto it{fingerprint_index.find(std::hash<std::string>{}(fingerprint))};
+    if (it == fingerprint_index.end())
+        return std::nullopt;
+    return it->second;
+}
+
+void BankBase::index_customer(Person* customer) {
+    auto accounts{customer_2_accounts.find(customer)};
+    if (accounts == customer_2_accounts.end())
+        throw std::logic_error("Customer must be in customer_2_accounts before it is indexed");
+
+    // std::map nodes are stable, so the vector address stays valid until the customer is erased
+    auto [it, inserted] = fingerprint_index.try_emplace(customer->get_hashed_fingerprint(),
+                                                        CustomerRecord{customer, &accounts->second});
+    if (!inserted && it->second.customer != customer)
+        throw std::invalid_argument("Fingerprint already belongs to another customer of this bank");
+}
+
+void BankBase::unindex_customer(const Person* customer) {
+    auto it{fingerprint_index.find(customer->get_hashed_fingerprint())};
+    if (it != fingerprint_index.end() && it->second.customer == customer)
+        fingerprint_index.erase(it);
+}
+
+template <class LoanPolicy>
+double BasicBank<LoanPolicy>::loan_headroom(const Person& owner) const {
+    auto it{customer_2_total_balance.find(&owner)};
+    Money total_balance{it == customer_2_total_balance.end() ? Money{} : it->second};
+#ifdef BANK_VERIFY_CACHES
+    if (total_balance != recompute_customer_balance(&owner))
+        throw std::logic_error("customer_2_total_balance is out of sync");
+#endif
+
+    Money unpaid_loan;
+    if (auto loan{customer_2_unpaid_loan.find(const_cast<Person*>(&owner))}; loan != customer_2_unpaid_loan.end())
+        unpaid_loan = Money::from_double(loan->second);
+
+    size_t rank{owner.get_socioeconomic_rank()};
+    if (!LoanPolicy::valid_rank(rank))
+        throw std::invalid_argument("Socioeconomic rank is outside the loan policy's range");
+    Money limit{LoanPolicy::loan_limit(total_balance, rank)};
+    return limit > unpaid_loan ? (limit - unpaid_loan).to_double() : 0.0;
+}
+
+void BankBase::adjust_customer_balance(const Person* owner, Money delta) {
+    auto it{customer_2_total_balance.try_emplace(owner).first};
+    it->second += delta;
+    if (it->second == Money{})
+        customer_2_total_balance.erase(it);
+}
+
+void BankBase::erase_customer_balance(const Person* owner) {
+    customer_2_total_balance.erase(owner);
+}
+
+Money BankBase::recompute_customer_balance(const Person* owner) const {
+    Money total;
+    if (auto it{customer_2_accounts.find(const_cast<Person*>(owner))}; it != customer_2_accounts.end())
+        for (const Account* account : it->second)
+            total += account->balance;
+    return total;
+}
+
+AuthSession::AuthSession(const BankBase* bank, const Person* owner, uint64_t id)
+    : bank{bank}, owner{owner}, id{id} {}
+
+const BankBase* AuthSession::get_bank() const {
+    return bank;
+}
+
+const Person* AuthSession::get_owner() const {
+    return owner;
+}
+
+AuthSession BankBase::authenticate(const Person& owner, const std::string& owner_fingerprint) {
+    if (std::hash<std::string>{}(owner_fingerprint) != owner.get_hashed_fingerprint())
+        throw std::invalid_argument("Owner authentication failed");
+    if (!customer_2_accounts.contains(const_cast<Person*>(&owner)))
+        throw std::invalid_argument("Owner is not a customer of this bank");
+
+    uint64_t id{next_session_id()};
+    active_sessions.emplace(id, &owner);
+    return AuthSession(this, &owner, id);
+}
+
+AuthSession BankBase::authenticate_bank(const std::string& bank_fingerprint) {
+    if (std::hash<std::string>{}(bank_fingerprint) != hashed_bank_fingerprint)
+        throw std::invalid_argument("Bank authentication failed");
+
+    uint64_t id{next_session_id()};
+    active_sessions.emplace(id, nullptr);
+    return AuthSession(this, nullptr, id);
+}
+
+bool BankBase::revoke(const AuthSession& session) {
+    return session.bank == this && active_sessions.erase(session.id) > 0;
+}
+
+void BankBase::check_session(const AuthSession& session, const Person* owner) const {
+    if (session.bank != this || session.owner != owner || !active_sessions.contains(session.id))
+        throw std::invalid_argument("Session is not valid for this operation");
+}
+
+void BankBase::revoke_sessions(const Person* owner) {
+    std::erase_if(active_sessions, [owner](const auto& session) { return session.second == owner; });
+}
+
+const std::vector<Person*>& BankBase::get_bank_customers(const AuthSession& bank_session) const {
+    check_session(bank_session, nullptr);
+    return bank_customers;
+}
+
+const std::vector<Account*>& BankBase::get_bank_accounts(const AuthSession& bank_session) const {
+    check_session(bank_session, nullptr);
+    return bank_accounts;
+}
+
+const std::map<Account*, Person*>& BankBase::get_account_2_customer_map(const AuthSession& bank_session) const {
+    check_session(bank_session, nullptr);
+    return account_2_customer;
+}
+
+const std::map<Person*, std::vector<Account*>>& BankBase::get_customer_2_accounts_map(const AuthSession& bank_session) const {
+    check_session(bank_session, nullptr);
+    return customer_2_accounts;
+}
+
+const std::map<Person*, double>& BankBase::get_customer_2_paid_loan_map(const AuthSession& bank_session) const {
+    check_session(bank_session, nullptr);
+    return customer_2_paid_loan;
+}
+
+const std::map<Person*, double>& BankBase::get_customer_2_unpaid_loan_map(const AuthSession& bank_session) const {
+    check_session(bank_session, nullptr);
+    return customer_2_unpaid_loan;
+}
+
+double BankBase::get_bank_total_balance(const AuthSession& bank_session) const {
+    check_session(bank_session, nullptr);
+    return bank_total_balance.to_double();
+}
+
+double BankBase::get_bank_total_loan(const AuthSession& bank_session) const {
+    check_session(bank_session, nullptr);
+    return bank_total_loan.to_double();
+}
+
+void BankBase::export_info(const std::string& file_name, ExportFormat format) const {
+    // Customers are keyed by their position in bank_customers so account rows can be joined back to them
+    std::unordered_map<const Person*, size_t> customer_ids;
+    customer_ids.reserve(bank_customers.size());
+    for (size_t id{0}; id < bank_customers.size(); ++id)
+        customer_ids.emplace(bank_customers[id], id);
+
+    ExportBuffer output{file_name};
+    bool csv{format == ExportFormat::CSV};
+    if (csv) {
+        output.append("type,customer_id,account_number,name,age,gender,socioeconomic_rank,is_alive,balance,status,paid_loan,unpaid_loan");
+        output.end_record();
+    }
+
+    for (const Account* account : bank_accounts) {
+        size_t customer_id{customer_ids.at(account->owner)};
+        std::string owner_name{account->owner->get_name()};
+        if (csv) {
+            output.append("account,");
+            output.append_number(customer_id);
+            output.append(',');
+            output.append_digits(account->account_number, 16);
+            output.append(',');
+            output.append_csv_field(owner_name);
+            output.append(",,,,,");
+            output.append_money(account->balance);
+            output.append(account->account_status ? ",true,," : ",false,,");
+        } else {
+            output.append(R"({"type":"account","customer_id":)");
+            output.append_number(customer_id);
+            output.append(R"(,"account_number":")");
+            output.append_digits(account->account_number, 16);
+            output.append(R"(","owner":)");
+            output.append_json_string(owner_name);
+            output.append(R"(,"balance":)");
+            output.append_money(account->balance);
+            output.append(account->account_status ? R"(,"status":true})" : R"(,"status":false})");
+        }
+        output.end_record();
+    }
+
+    for (size_t customer_id{0}; customer_id < bank_customers.size(); ++customer_id) {
+        Person* customer{bank_customers[customer_id]};
+        auto paid{customer_2_paid_loan.find(customer)};
+        auto unpaid{customer_2_unpaid_loan.find(customer)};
+        Money paid_loan{paid == customer_2_paid_loan.end() ? Money{} : Money::from_double(paid->second)};
+        Money unpaid_loan{unpaid == customer_2_unpaid_loan.end() ? Money{} : Money::from_double(unpaid->second)};
+        if (csv) {
+            output.append("customer,");
+            output.append_number(customer_id);
+            output.append(",,");
+            output.append_csv_field(customer->get_name());
+            output.append(',');
+            output.append_number(customer->get_age());
+            output.append(',');
+            output.append(customer->get_gender());
+            output.append(',');
+            output.append_number(customer->get_socioeconomic_rank());
+            output.append(customer->get_is_alive() ? ",true,,," : ",false,,,");
+            output.append_money(paid_loan);
+            output.append(',');
+            output.append_money(unpaid_loan);
+        } else {
+            output.append(R"({"type":"customer","customer_id":)");
+            output.append_number(customer_id);
+            output.append(R"(,"name":)");
+            output.append_json_string(customer->get_name());
+            output.append(R"(,"age":)");
+            output.append_number(customer->get_age());
+            output.append(R"(,"gender":")");
+            output.append(customer->get_gender());
+            output.append(R"(","socioeconomic_rank":)");
+            output.append_number(customer->get_socioeconomic_rank());
+            output.append(customer->get_is_alive() ? R"(,"is_alive":true,"paid_loan":)" : R"(,"is_alive":false,"paid_loan":)");
+            output.append_money(paid_loan);
+            output.append(R"(,"unpaid_loan":)");
+            output.append_money(unpaid_loan);
+            output.append('}');
+        }
+        output.end_record();
+    }
+    output.finish();
+}
+
+// One line per loan policy in use
+template class BasicBank<DefaultLoanPolicy>;
@@ -1 +1,281 @@
-#include "Utils.h"
\ No newline at end of file
+#include "Utils.h"
+
+#include <array>     // For std::array
+#include <atomic>    // For std::atomic
+#include <charconv>  // For std::to_chars
+#include <cmath>     // For std::isfinite, std::llround
+#include <limits>    // For std::numeric_limits
+#include <random>    // For std::random_device
+#include <stdexcept> // For std::overflow_error, std::invalid_argument, std::runtime_error
+#include <utility>   // For std::swap
+
+namespace {
+
+constexpr uint64_t account_number_space{10'000'000'000'000'000}; // 10^16, all 16-digit strings
+constexpr unsigned feistel_half_bits{27}; // 2^54 covers the account number space
+constexpr uint64_t feistel_half_mask{(uint64_t{1} << feistel_half_bits) - 1};
+
+// SplitMix64 finalizer, used both as the PRNG output and as the Feistel round function
+uint64_t mix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+uint64_t seed_from_device() {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) ^ device();
+}
+
+// Feistel round keys, random per process unless restored by set_account_number_state
+std::array<uint64_t, 4>& feistel_keys() {
+    static std::array<uint64_t, 4> keys{seed_from_device(), seed_from_device(),
+                                        seed_from_device(), seed_from_device()};
+    return keys;
+}
+
+// Next unused index of the account number space
+std::atomic<uint64_t>& next_account_index() {
+    static std::atomic<uint64_t> next_index{0};
+    return next_index;
+}
+
+// Permutes [0, 10^16) with a 4-round Feistel network over 54 bits, cycle-walking back into range
+uint64_t permute_account_number(uint64_t index) {
+    const std::array<uint64_t, 4>& keys{feistel_keys()};
+    do {
+        uint64_t left{index >> feistel_half_bits};
+        uint64_t right{index & feistel_half_mask};
+        for (uint64_t key : keys) {
+            left ^= mix64(right ^ key) & feistel_half_mask;
+            std::swap(left, right);
+        }
+        index = (left << feistel_half_bits) | right;
+    } while (index >= account_number_space);
+    return index;
+}
+
+// Reserves count consecutive indices of the account number space
+uint64_t reserve_account_numbers(size_t count) {
+    uint64_t first{next_account_index().fetch_add(count, std::memory_order_relaxed)};
+    if (count > account_number_space || first > account_number_space - count)
+        throw std::overflow_error("Account number space exhausted");
+    return first;
+}
+
+} // namespace
+
+std::optional<uint64_t> pack_account_number(std::string_view account_number) {
+    if (account_number.size() != 16)
+        return std::nullopt;
+
+    uint64_t packed{0};
+    for (char digit : account_number) {
+        if (digit < '0' || digit > '9')
+            return std::nullopt;
+        packed = packed * 10 + static_cast<uint64_t>(digit - '0');
+    }
+    return packed;
+}
+
+std::string format_digits(uint64_t value, size_t width) {
+    char buffer[20];
+    auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    size_t length{static_cast<size_t>(end - buffer)};
+    if (length > width)
+        throw std::invalid_argument("Value has more digits than the field width");
+
+    std::string digits(width - length, '0');
+    digits.append(buffer, end);
+    return digits;
+}
+
+uint64_t random_u64() {
+    thread_local uint64_t state{seed_from_device()};
+    state += 0x9e3779b97f4a7c15;
+    return mix64(state);
+}
+
+uint64_t generate_account_number() {
+    return permute_account_number(reserve_account_numbers(1));
+}
+
+std::vector<uint64_t> generate_account_numbers(size_t count) {
+    uint64_t first{reserve_account_numbers(count)};
+    std::vector<uint64_t> account_numbers;
+    account_numbers.reserve(count);
+    for (uint64_t index{first}; index < first + count; ++index)
+        account_numbers.push_back(permute_account_number(index));
+    return account_numbers;
+}
+
+AccountNumberState get_account_number_state() {
+    return AccountNumberState{feistel_keys(), next_account_index().load(std::memory_order_relaxed)};
+}
+
+void set_account_number_state(const AccountNumberState& state) {
+    if (state.next_index > account_number_space)
+        throw std::invalid_argument("Account number index is outside the account number space");
+
+    feistel_keys() = state.keys;
+    next_account_index().store(state.next_index, std::memory_order_relaxed);
+}
+
+uint16_t generate_cvv2() {
+    return static_cast<uint16_t>(random_u64() % 10'000);
+}
+
+Money Money::from_minor(int64_t minor_units) {
+    Money money;
+    money.minor_units = minor_units;
+    return money;
+}
+
+Money Money::from_double(double amount) {
+    if (!std::isfinite(amount))
+        throw std::invalid_argument("Money amount must be finite");
+
+    double minor{amount * minor_per_unit};
+    if (minor >= 9.2e18 || minor <= -9.2e18)
+        throw std::overflow_error("Money amount out of range");
+    return from_minor(std::llround(minor));
+}
+
+int64_t Money::get_minor_units() const {
+    return minor_units;
+}
+
+double Money::to_double() const {
+    return static_cast<double>(minor_units) / minor_per_unit;
+}
+
+Money& Money::operator+=(const Money& other) {
+    if ((other.minor_units > 0 && minor_units > std::numeric_limits<int64_t>::max() - other.minor_units) ||
+        (other.minor_units < 0 && minor_units < std::numeric_limits<int64_t>::min() - other.minor_units))
+        throw std::overflow_error("Money addition overflow");
+    minor_units += other.minor_units;
+    return *this;
+}
+
+Money& Money::operator-=(const Money& other) {
+    if ((other.minor_units < 0 && minor_units > std::numeric_limits<int64_t>::max() + other.minor_units) ||
+        (other.minor_units > 0 && minor_units < std::numeric_limits<int64_t>::min() + other.minor_units))
+        throw std::overflow_error("Money subtraction overflow");
+    minor_units -= other.minor_units;
+    return *this;
+}
+
+Money Money::operator+(const Money& other) const {
+    Money result{*this};
+    return result += other;
+}
+
+Money Money::operator-(const Money& other) const {
+    Money result{*this};
+    return result -= other;
+}
+
+Money Money::scaled(int64_t numerator, int64_t denominator) const {
+    if (denominator <= 0)
+        throw std::invalid_argument("Money scale denominator must be positive");
+
+    // 128-bit intermediate holds any int64 * int64 product, so INT64_MIN needs no special case
+    __extension__ typedef __int128 wide_int;
+    wide_int product{static_cast<wide_int>(minor_units) * numerator};
+    wide_int rounded{product / denominator};
+    wide_int remainder{product % denominator};
+    if (remainder < 0 ? -2 * remainder >= denominator : 2 * remainder >= denominator)
+        rounded += remainder < 0 ? -1 : 1;
+
+    if (rounded > std::numeric_limits<int64_t>::max() || rounded < std::numeric_limits<int64_t>::min())
+        throw std::overflow_error("Money scale overflow");
+    return Money::from_minor(static_cast<int64_t>(rounded));
+}
+
+ExportBuffer::ExportBuffer(const std::string& file_name) : file{file_name, std::ios::binary} {
+    if (!file)
+        throw std::runtime_error("Cannot open export file " + file_name);
+    buffer.reserve(flush_threshold + 4096);
+}
+
+void ExportBuffer::append(std::string_view text) {
+    buffer.append(text);
+}
+
+void ExportBuffer::append(char c) {
+    buffer.push_back(c);
+}
+
+void ExportBuffer::append_digits(uint64_t value, size_t width) {
+    char digits[20];
+    auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+    size_t length{static_cast<size_t>(end - digits)};
+    if (length > width)
+        throw std::invalid_argument("Value has more digits than the field width");
+    buffer.append(width - length, '0');
+    buffer.append(digits, end);
+}
+
+void ExportBuffer::append_money(Money amount) {
+    // Unsigned magnitude so INT64_MIN formats without overflow
+    int64_t minor_units{amount.get_minor_units()};
+    uint64_t magnitude{minor_units < 0 ? uint64_t{0} - static_cast<uint64_t>(minor_units)
+                                       : static_cast<uint64_t>(minor_units)};
+    if (minor_units < 0)
+        buffer.push_back('-');
+    append_number(magnitude / Money::minor_per_unit);
+    buffer.push_back('.');
+    append_digits(magnitude % Money::minor_per_unit, 2);
+}
+
+void ExportBuffer::append_csv_field(std::string_view text) {
+    if (text.find_first_of(",\"\n\r") == std::string_view::npos) {
+        buffer.append(text);
+        return;
+    }
+    buffer.push_back('"');
+    for (char c : text) {
+        if (c == '"')
+            buffer.push_back('"');
+        buffer.push_back(c);
+    }
+    buffer.push_back('"');
+}
+
+void ExportBuffer::append_json_string(std::string_view text) {
+    static constexpr char hex[]{"0123456789abcdef"};
+    buffer.push_back('"');
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            buffer.push_back('\\');
+            buffer.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            buffer.append("\\u00");
+            buffer.push_back(hex[(c >> 4) & 0xf]);
+            buffer.push_back(hex[c & 0xf]);
+        } else {
+            buffer.push_back(c);
+        }
+    }
+    buffer.push_back('"');
+}
+
+void ExportBuffer::end_record() {
+    buffer.push_back('\n');
+    if (buffer.size() >= flush_threshold)
+        flush();
+}
+
+void ExportBuffer::flush() {
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+    if (!file)
+        throw std::runtime_error("Failed writing export file");
+}
+
+void ExportBuffer::finish() {
+    flush();
+    file.close();
+    if (!file)
+        throw std::runtime_error("Failed writing export file");
+}
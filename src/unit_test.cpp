@@ -3,12 +3,15 @@
 #include <functional>  // For std::hash
 #include <fstream> // For file operations
 #include <regex> // Include for std::regex
+#include <unordered_set> // For std::unordered_set
 #include <cmath>
+#include <limits> // For std::numeric_limits
 
 
 #include "Account.h" 
 #include "Bank.h"
 #include "Person.h"
+#include "Utils.h"
 
 
 // "============================================="
@@ -758,4 +761,292 @@ TEST_F(BankTest, Bank_PayLoanSuccessAndRankUpgrade) {
 
     // Clean up
     delete person;
+}
+
+
+TEST_F(BankTest, Bank_SessionGrantsGetterAccess) {
+    Bank bank = createValidBank();
+
+    AuthSession session = bank.authenticate_bank(validBankFingerprint);
+    EXPECT_EQ(session.get_bank(), &bank) << "Session should be scoped to the bank that issued it.";
+    EXPECT_EQ(session.get_owner(), nullptr) << "A bank session should have no owner.";
+    EXPECT_NO_THROW(bank.get_bank_accounts(session)) << "A live bank session should grant access to bank getters.";
+
+    std::string wrongFingerprint = "wrongBankFingerprint";
+    EXPECT_ANY_THROW(bank.authenticate_bank(wrongFingerprint)) << "A wrong bank fingerprint should not issue a session.";
+}
+
+TEST_F(BankTest, Bank_RevokedSessionIsRejected) {
+    Bank bank = createValidBank();
+
+    AuthSession session = bank.authenticate_bank(validBankFingerprint);
+    EXPECT_TRUE(bank.revoke(session)) << "Revoking a live session should succeed.";
+    EXPECT_FALSE(bank.revoke(session)) << "Revoking a session twice should fail.";
+    EXPECT_ANY_THROW(bank.get_bank_accounts(session)) << "A revoked session should not grant access.";
+    EXPECT_ANY_THROW(bank.get_bank_total_balance(session)) << "A revoked session should not grant access.";
+}
+
+TEST_F(BankTest, Bank_ForeignSessionIsRejected) {
+    Bank bank = createValidBank();
+    Bank otherBank = createValidBank();
+
+    AuthSession otherSession = otherBank.authenticate_bank(validBankFingerprint);
+    EXPECT_ANY_THROW(bank.get_bank_accounts(otherSession)) << "A session issued by another bank should not grant access.";
+    EXPECT_FALSE(bank.revoke(otherSession)) << "A bank should not revoke another bank's session.";
+
+    // Session ids are never reused across banks, so a fresh session here cannot collide with the other one
+    AuthSession session = bank.authenticate_bank(validBankFingerprint);
+    EXPECT_TRUE(otherBank.revoke(otherSession)) << "The issuing bank should still be able to revoke its session.";
+    EXPECT_NO_THROW(bank.get_bank_accounts(session)) << "Revoking another bank's session should not affect this one.";
+}
+
+// "============================================="
+// "               Money Class Tests             "
+// "============================================="
+
+class MoneyTest : public ::testing::Test {
+protected:
+    int64_t maxMinorUnits = std::numeric_limits<int64_t>::max();
+    int64_t minMinorUnits = std::numeric_limits<int64_t>::min();
+
+    // Utility function for building an amount directly in cents
+    Money cents(int64_t minorUnits) {
+        return Money::from_minor(minorUnits);
+    }
+};
+
+TEST_F(MoneyTest, Money_FromDoubleRoundsToMinorUnits) {
+    EXPECT_EQ(Money::from_double(1000.0).get_minor_units(), 100000) << "1000.0 should be stored as 100000 cents.";
+    EXPECT_EQ(Money::from_double(1.25).get_minor_units(), 125) << "1.25 should be stored as 125 cents.";
+    EXPECT_EQ(Money::from_double(-2.5).get_minor_units(), -250) << "-2.5 should be stored as -250 cents.";
+    EXPECT_EQ(Money::from_double(0.1).get_minor_units(), 10) << "0.1 should round to 10 cents despite binary representation.";
+    EXPECT_EQ(cents(12345).to_double(), 123.45) << "to_double() should convert cents back to units.";
+}
+
+TEST_F(MoneyTest, Money_FromDoubleRejectsInvalidAmounts) {
+    EXPECT_ANY_THROW(Money::from_double(std::nan(""))) << "NaN should not convert to Money.";
+    EXPECT_ANY_THROW(Money::from_double(std::numeric_limits<double>::infinity())) << "Infinity should not convert to Money.";
+    EXPECT_ANY_THROW(Money::from_double(1e17)) << "Amounts beyond int64 cents should throw.";
+}
+
+TEST_F(MoneyTest, Money_ArithmeticAndComparison) {
+    EXPECT_EQ((cents(150) + cents(250)).get_minor_units(), 400) << "Addition should be exact in cents.";
+    EXPECT_EQ((cents(150) - cents(250)).get_minor_units(), -100) << "Subtraction should be exact in cents.";
+    EXPECT_TRUE(cents(100) < cents(101)) << "Money should order by minor units.";
+    EXPECT_TRUE(cents(100) == Money::from_double(1.0)) << "Equal amounts should compare equal.";
+    EXPECT_EQ(Money{}.get_minor_units(), 0) << "Default Money should be zero.";
+}
+
+TEST_F(MoneyTest, Money_ArithmeticOverflowThrows) {
+    EXPECT_ANY_THROW(cents(maxMinorUnits) + cents(1)) << "Adding past int64 max should throw.";
+    EXPECT_ANY_THROW(cents(minMinorUnits) - cents(1)) << "Subtracting past int64 min should throw.";
+    EXPECT_ANY_THROW(cents(minMinorUnits) + cents(-1)) << "Adding a negative past int64 min should throw.";
+    EXPECT_NO_THROW(cents(maxMinorUnits) + cents(minMinorUnits)) << "Opposite extremes should add without overflow.";
+}
+
+TEST_F(MoneyTest, Money_ScaledRoundsHalfAwayFromZero) {
+    EXPECT_EQ(cents(5).scaled(1, 2).get_minor_units(), 3) << "2.5 cents should round up to 3.";
+    EXPECT_EQ(cents(-5).scaled(1, 2).get_minor_units(), -3) << "-2.5 cents should round down to -3.";
+    EXPECT_EQ(cents(4).scaled(1, 3).get_minor_units(), 1) << "1.33 cents should round to 1.";
+    EXPECT_EQ(cents(100000).scaled(10, 600).get_minor_units(), 1667) << "10/6 percent of 1000.00 should be 16.67.";
+    EXPECT_EQ(cents(1000000).scaled(80, 100).get_minor_units(), 800000) << "80 percent of 10000.00 should be 8000.00.";
+}
+
+TEST_F(MoneyTest, Money_ScaledHandlesExtremes) {
+    EXPECT_EQ(cents(minMinorUnits).scaled(1, 1).get_minor_units(), minMinorUnits) << "Scaling int64 min by one should be exact.";
+    EXPECT_EQ(cents(maxMinorUnits).scaled(maxMinorUnits, maxMinorUnits).get_minor_units(), maxMinorUnits) << "Large intermediate products should not overflow.";
+    EXPECT_ANY_THROW(cents(minMinorUnits).scaled(-1, 1)) << "Negating int64 min should throw.";
+    EXPECT_ANY_THROW(cents(maxMinorUnits).scaled(2, 1)) << "Results beyond int64 should throw.";
+    EXPECT_ANY_THROW(cents(100).scaled(1, 0)) << "A zero denominator should throw.";
+}
+
+
+// "============================================="
+// "               Utils Function Tests          "
+// "============================================="
+
+class UtilsTest : public ::testing::Test {
+protected:
+    std::string validAccountNumber = "0123456789012345";
+    size_t generatedCount = 200000;
+    uint64_t accountNumberSpace = 10000000000000000ULL; // 10^16
+};
+
+TEST_F(UtilsTest, Utils_PackAccountNumber) {
+    auto packed = pack_account_number(validAccountNumber);
+    ASSERT_TRUE(packed.has_value()) << "A 16-digit account number should pack.";
+    EXPECT_EQ(*packed, 123456789012345ULL) << "Packed value should equal the digits read as a number.";
+    EXPECT_FALSE(pack_account_number("123456789012345").has_value()) << "15 digits should be rejected.";
+    EXPECT_FALSE(pack_account_number("12345678901234567").has_value()) << "17 digits should be rejected.";
+    EXPECT_FALSE(pack_account_number("12345678901234a5").has_value()) << "Non-digit characters should be rejected.";
+}
+
+TEST_F(UtilsTest, Utils_FormatDigits) {
+    EXPECT_EQ(format_digits(42, 4), "0042") << "Values should be zero-padded to the width.";
+    EXPECT_EQ(format_digits(9999, 4), "9999") << "A value of exactly width digits should be unchanged.";
+    EXPECT_EQ(format_digits(0, 16), "0000000000000000") << "Zero should format as all zeros.";
+    EXPECT_EQ(format_digits(*pack_account_number(validAccountNumber), 16), validAccountNumber) << "Formatting should invert packing.";
+    EXPECT_ANY_THROW(format_digits(12345, 4)) << "Values wider than the width should throw instead of being truncated.";
+}
+
+TEST_F(UtilsTest, Utils_GeneratedAccountNumbersAreUniqueAndInRange) {
+    std::vector<uint64_t> accountNumbers = generate_account_numbers(generatedCount);
+    ASSERT_EQ(accountNumbers.size(), generatedCount) << "Bulk generation should return the requested count.";
+    accountNumbers.push_back(generate_account_number());
+
+    std::unordered_set<uint64_t> seen;
+    for (uint64_t accountNumber : accountNumbers) {
+        EXPECT_LT(accountNumber, accountNumberSpace) << "Account number " << accountNumber << " has more than 16 digits.";
+        EXPECT_TRUE(seen.insert(accountNumber).second) << "Account number " << accountNumber << " was generated twice.";
+    }
+}
+
+TEST_F(UtilsTest, Utils_AccountNumberStateResumesWithoutCollisions) {
+    AccountNumberState originalState = get_account_number_state();
+
+    // Simulate a first process run with fixed keys
+    set_account_number_state(AccountNumberState{{1, 2, 3, 4}, 0});
+    std::vector<uint64_t> firstRun = generate_account_numbers(1000);
+    AccountNumberState savedState = get_account_number_state();
+    EXPECT_EQ(savedState.next_index, 1000) << "The saved index should follow the generated numbers.";
+
+    // The same keys and index reproduce the same numbers
+    set_account_number_state(AccountNumberState{{1, 2, 3, 4}, 0});
+    EXPECT_EQ(generate_account_numbers(1000), firstRun) << "Restored state should reproduce the same sequence.";
+
+    // A restart resuming from the saved state never repeats a number from the first run
+    set_account_number_state(savedState);
+    std::unordered_set<uint64_t> seen(firstRun.begin(), firstRun.end());
+    for (uint64_t accountNumber : generate_account_numbers(1000))
+        EXPECT_TRUE(seen.insert(accountNumber).second) << "Account number " << accountNumber << " collided after resuming.";
+
+    EXPECT_ANY_THROW(set_account_number_state(AccountNumberState{{1, 2, 3, 4}, accountNumberSpace + 1})) << "An index past the space should be rejected.";
+    set_account_number_state(originalState);
+}
+
+TEST_F(UtilsTest, Utils_GeneratedCVV2IsFourDigits) {
+    for (size_t i = 0; i < 1000; ++i) {
+        uint16_t cvv2 = generate_cvv2();
+        EXPECT_LT(cvv2, 10000) << "CVV2 " << cvv2 << " has more than 4 digits.";
+        EXPECT_EQ(format_digits(cvv2, 4).length(), 4) << "CVV2 should format as 4 digits.";
+    }
+}
+
+
+// "============================================="
+// "             ExportBuffer Tests              "
+// "============================================="
+
+class ExportBufferTest : public ::testing::Test {
+protected:
+    std::string filename = "test_export_buffer.txt";
+    std::vector<std::string> awkwardFields = {
+        "plain", "", "comma, inside", "quote \" inside", "\"\"", "line\nbreak", "carriage\rreturn",
+        "back\\slash", std::string("nul\0byte", 8), "tab\tand\x01control", "trailing,"};
+
+    void TearDown() override {
+        std::remove(filename.c_str());
+    }
+
+    std::string readFile() {
+        std::ifstream file(filename, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // Decodes one CSV field starting at pos and leaves pos on the separator after it
+    static std::string parseCsvField(const std::string& text, size_t& pos) {
+        if (text[pos] != '"') {
+            size_t end = text.find_first_of(",\n", pos);
+            std::string field = text.substr(pos, end - pos);
+            pos = end;
+            return field;
+        }
+        std::string field;
+        for (++pos; ; ++pos) {
+            if (text[pos] == '"' && text[pos + 1] == '"')
+                field.push_back(text[pos++]);
+            else if (text[pos] == '"')
+                break;
+            else
+                field.push_back(text[pos]);
+        }
+        ++pos;
+        return field;
+    }
+
+    // Decodes one JSON string starting at pos and leaves pos after the closing quote
+    static std::string parseJsonString(const std::string& text, size_t& pos) {
+        std::string value;
+        for (++pos; text[pos] != '"'; ++pos) {
+            if (text[pos] != '\\') {
+                value.push_back(text[pos]);
+            } else if (text[++pos] == 'u') {
+                value.push_back(static_cast<char>(std::stoi(text.substr(pos + 1, 4), nullptr, 16)));
+                pos += 4;
+            } else {
+                value.push_back(text[pos]);
+            }
+        }
+        ++pos;
+        return value;
+    }
+};
+
+TEST_F(ExportBufferTest, ExportBuffer_CsvFieldsRoundTrip) {
+    ExportBuffer output(filename);
+    for (const std::string& field : awkwardFields) {
+        output.append_csv_field(field);
+        output.append(',');
+        output.append_csv_field(field);
+        output.end_record();
+    }
+    output.finish();
+
+    std::string text = readFile();
+    size_t pos = 0;
+    for (const std::string& field : awkwardFields) {
+        EXPECT_EQ(parseCsvField(text, pos), field) << "First CSV field did not round-trip.";
+        ASSERT_EQ(text[pos++], ',') << "Fields should be separated by a comma.";
+        EXPECT_EQ(parseCsvField(text, pos), field) << "Second CSV field did not round-trip.";
+        ASSERT_EQ(text[pos++], '\n') << "Records should end with a newline.";
+    }
+    EXPECT_EQ(pos, text.size()) << "The file should contain exactly one record per field.";
+}
+
+TEST_F(ExportBufferTest, ExportBuffer_JsonStringsRoundTrip) {
+    ExportBuffer output(filename);
+    for (const std::string& field : awkwardFields) {
+        output.append(R"({"name":)");
+        output.append_json_string(field);
+        output.append('}');
+        output.end_record();
+    }
+    output.finish();
+
+    std::string text = readFile();
+    size_t pos = 0;
+    for (const std::string& field : awkwardFields) {
+        ASSERT_EQ(text.compare(pos, 8, R"({"name":)"), 0) << "Record should start with the name key.";
+        pos += 8;
+        size_t end = text.find('\n', pos);
+        for (size_t i = pos; i < end; ++i)
+            EXPECT_GE(static_cast<unsigned char>(text[i]), 0x20) << "Control characters should be escaped.";
+        EXPECT_EQ(parseJsonString(text, pos), field) << "JSON string did not round-trip.";
+        ASSERT_EQ(text.compare(pos, 2, "}\n"), 0) << "Record should end after the string.";
+        pos += 2;
+    }
+    EXPECT_EQ(pos, text.size()) << "The file should contain exactly one record per field.";
+}
+
+TEST_F(ExportBufferTest, ExportBuffer_MoneyIsExact) {
+    ExportBuffer output(filename);
+    for (int64_t minorUnits : {int64_t{0}, int64_t{5}, int64_t{-5}, int64_t{1234567}, int64_t{-100},
+                               std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()}) {
+        output.append_money(Money::from_minor(minorUnits));
+        output.end_record();
+    }
+    output.finish();
+
+    EXPECT_EQ(readFile(), "0.00\n0.05\n-0.05\n12345.67\n-1.00\n92233720368547758.07\n-92233720368547758.08\n")
+        << "Money should be written from minor units without rounding.";
 }
\ No newline at end of file